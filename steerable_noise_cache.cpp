@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2025 Casual Garage Coder
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "steerable_noise_cache.h"
+
+#include "core/math/math_funcs.h"
+#include "core/templates/hashfuncs.h"
+
+SteerableNoiseCache::SteerableNoiseCache() :
+		capacity(0),
+		version(1) {}
+
+void SteerableNoiseCache::set_capacity(uint32_t c) {
+	// Round up to a power of two, with at least one probe window per stripe.
+	// Stripes are only allocated by their first store, so a cache never used costs nothing.
+	uint32_t per_stripe = c > 0 ? next_power_of_2(MAX(c / STRIPE_COUNT, MAX_PROBES)) : 0;
+	capacity.set(per_stripe * STRIPE_COUNT);
+	release();
+}
+
+uint32_t SteerableNoiseCache::get_capacity() const {
+	return capacity.get();
+}
+
+void SteerableNoiseCache::invalidate() {
+	// Skip 0 on wrap-around, as it is reserved for empty slots.
+	if (version.increment() == 0) {
+		version.increment();
+	}
+}
+
+void SteerableNoiseCache::clear() {
+	for (uint32_t s = 0; s < STRIPE_COUNT; ++s) {
+		MutexLock lock(stripes[s].mutex);
+		for (Entry &e : stripes[s].entries) {
+			e.version = 0;
+		}
+	}
+}
+
+void SteerableNoiseCache::release() {
+	for (uint32_t s = 0; s < STRIPE_COUNT; ++s) {
+		MutexLock lock(stripes[s].mutex);
+		stripes[s].entries.reset();
+	}
+}
+
+uint32_t SteerableNoiseCache::hash(const Vector3i &key, uint32_t dims) {
+	uint32_t h = hash_murmur3_one_32(key.x);
+	h = hash_murmur3_one_32(key.y, h);
+	h = hash_murmur3_one_32(key.z, h);
+	h = hash_murmur3_one_32(dims, h);
+	return hash_fmix32(h);
+}
+
+bool SteerableNoiseCache::lookup(const Vector3i &key, uint32_t dims, uint32_t v, real_t &r_value) const {
+	uint32_t h = hash(key, dims);
+	const Stripe &stripe = stripes[h & (STRIPE_COUNT - 1)];
+	MutexLock lock(stripe.mutex);
+	uint32_t size = stripe.entries.size();
+	if (size > 0) {
+		uint32_t mask = size - 1;
+		uint32_t home = h >> STRIPE_BITS;
+		for (uint32_t i = 0; i < MAX_PROBES; ++i) {
+			const Entry &e = stripe.entries[(home + i) & mask];
+			if (e.version == v && e.dims == dims && e.key == key) {
+				r_value = e.value;
+				stripe.hits++;
+				return true;
+			}
+		}
+	}
+	stripe.misses++;
+	return false;
+}
+
+void SteerableNoiseCache::store(const Vector3i &key, uint32_t dims, uint32_t v, real_t value) {
+	uint32_t h = hash(key, dims);
+	Stripe &stripe = stripes[h & (STRIPE_COUNT - 1)];
+	MutexLock lock(stripe.mutex);
+	uint32_t size = stripe.entries.size();
+	if (size == 0) {
+		size = capacity.get() / STRIPE_COUNT;
+		if (size == 0) {
+			return;
+		}
+		stripe.entries.resize(size);
+	}
+	uint32_t mask = size - 1;
+	uint32_t home = h >> STRIPE_BITS;
+	// Take the first slot that is free, stale or already ours; evict the home slot otherwise.
+	uint32_t slot = home & mask;
+	for (uint32_t i = 0; i < MAX_PROBES; ++i) {
+		const Entry &e = stripe.entries[(home + i) & mask];
+		if (e.version != v || (e.dims == dims && e.key == key)) {
+			slot = (home + i) & mask;
+			break;
+		}
+	}
+	Entry &e = stripe.entries[slot];
+	e.key = key;
+	e.dims = dims;
+	e.version = v;
+	e.value = value;
+}
+
+uint64_t SteerableNoiseCache::get_hits() const {
+	uint64_t total = 0;
+	for (uint32_t s = 0; s < STRIPE_COUNT; ++s) {
+		MutexLock lock(stripes[s].mutex);
+		total += stripes[s].hits;
+	}
+	return total;
+}
+
+uint64_t SteerableNoiseCache::get_misses() const {
+	uint64_t total = 0;
+	for (uint32_t s = 0; s < STRIPE_COUNT; ++s) {
+		MutexLock lock(stripes[s].mutex);
+		total += stripes[s].misses;
+	}
+	return total;
+}
+
+void SteerableNoiseCache::reset_statistics() {
+	for (uint32_t s = 0; s < STRIPE_COUNT; ++s) {
+		MutexLock lock(stripes[s].mutex);
+		stripes[s].hits = 0;
+		stripes[s].misses = 0;
+	}
+}
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2025 Casual Garage Coder
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "core/math/vector3i.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
+#include "core/typedefs.h"
+
+// Bounded, thread-safe point cache used by SteerablePerlinNoise.
+// The table is split in stripes, each one being a small open-addressing table
+// guarded by its own mutex, so concurrent queries rarely contend.
+// Entries are tagged with a version: bumping it invalidates everything at once.
+class SteerableNoiseCache {
+public:
+	SteerableNoiseCache();
+
+	void set_capacity(uint32_t c);
+	uint32_t get_capacity() const;
+
+	_FORCE_INLINE_ uint32_t get_version() const { return version.get(); }
+	void invalidate();
+	void clear();
+	void release();
+
+	bool lookup(const Vector3i &key, uint32_t dims, uint32_t v, real_t &r_value) const;
+	void store(const Vector3i &key, uint32_t dims, uint32_t v, real_t value);
+
+	uint64_t get_hits() const;
+	uint64_t get_misses() const;
+	void reset_statistics();
+
+private:
+	static constexpr uint32_t STRIPE_BITS = 4;
+	static constexpr uint32_t STRIPE_COUNT = 1 << STRIPE_BITS;
+	static constexpr uint32_t MAX_PROBES = 4;
+
+	struct Entry {
+		Vector3i key;
+		uint32_t dims = 0;
+		// 0 marks an empty slot, live versions start at 1.
+		uint32_t version = 0;
+		real_t value = 0.;
+	};
+
+	// Cache line aligned so neighbouring stripes do not share their mutex and counters.
+	struct alignas(64) Stripe {
+		mutable BinaryMutex mutex;
+		LocalVector<Entry> entries;
+		// Counted under the stripe mutex, so queries never share a counter cache line.
+		mutable uint64_t hits = 0;
+		mutable uint64_t misses = 0;
+	};
+
+	static uint32_t hash(const Vector3i &key, uint32_t dims);
+
+	Stripe stripes[STRIPE_COUNT];
+
+	// Read by stores that lazily allocate their stripe.
+	SafeNumeric<uint32_t> capacity;
+
+	SafeNumeric<uint32_t> version;
+};
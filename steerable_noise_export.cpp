@@ -0,0 +1,204 @@
+/*
+MIT License
+
+Copyright (c) 2025 Casual Garage Coder
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "core/error/error_macros.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/marshalls.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/local_vector.h"
+#include "core/typedefs.h"
+#include "steerable_perlin_noise.h"
+
+// Sidecar file storing how many rows of an export are safely on disk.
+#define EXPORT_PROGRESS_SUFFIX ".progress"
+#define EXPORT_PROGRESS_MAGIC 0x53504e58
+
+uint32_t SteerablePerlinNoise::_parameters_hash() const {
+	uint32_t h = hash_murmur3_one_32(seed);
+	for (int i = 0; i < 3; ++i) {
+		h = hash_murmur3_one_real(frequency[i], h);
+		h = hash_murmur3_one_real(offset[i], h);
+		h = hash_murmur3_one_real(scale[i], h);
+	}
+	h = hash_murmur3_one_real(anisotropy_strength, h);
+	h = hash_murmur3_one_real(anisotropy_vector_scale.x, h);
+	h = hash_murmur3_one_real(anisotropy_vector_scale.y, h);
+	h = hash_murmur3_one_real(octave_bias, h);
+	h = hash_murmur3_one_32(octaves, h);
+	h = hash_murmur3_one_32(noise_order, h);
+	h = hash_murmur3_one_real(eigen_value_sum, h);
+
+	// The anisotropy map drives the 2D field too. Its stored properties are hashed generically;
+	// object-valued ones hash by instance, so resuming across sessions is refused for them.
+	h = hash_murmur3_one_32(anisotropy_map.is_valid(), h);
+	if (anisotropy_map.is_valid()) {
+		h = hash_murmur3_one_32(String(anisotropy_map->get_class()).hash(), h);
+		List<PropertyInfo> properties;
+		anisotropy_map->get_property_list(&properties);
+		for (const PropertyInfo &pi : properties) {
+			if (pi.usage & PROPERTY_USAGE_STORAGE) {
+				h = hash_murmur3_one_32(pi.name.hash(), h);
+				h = hash_murmur3_one_32(anisotropy_map->get(pi.name).recursive_hash(0), h);
+			}
+		}
+	}
+	return hash_fmix32(h);
+}
+
+void SteerablePerlinNoise::_export_row(uint32_t p_index, ExportBand *p_band) const {
+	real_t *row = p_band->values + p_index * p_band->width;
+	int y = p_band->first_row + p_index;
+	for (int x = 0; x < p_band->width; ++x) {
+		row[x] = _sample_octaves(x, y, 0, p_band->in_3d_space, 0, octaves, 0.);
+	}
+}
+
+int SteerablePerlinNoise::_read_export_progress(const String &p_path, const ExportProgress &p_progress) {
+	// Only resume a file produced with the very same request and parameters.
+	Ref<FileAccess> pf = FileAccess::open(p_path, FileAccess::READ);
+	if (pf.is_null() || pf->get_32() != EXPORT_PROGRESS_MAGIC ||
+			pf->get_32() != static_cast<uint32_t>(p_progress.width) ||
+			pf->get_32() != static_cast<uint32_t>(p_progress.height) ||
+			pf->get_32() != static_cast<uint32_t>(p_progress.format) ||
+			pf->get_32() != static_cast<uint32_t>(p_progress.in_3d_space) ||
+			pf->get_float() != static_cast<float>(p_progress.r16_range.x) ||
+			pf->get_float() != static_cast<float>(p_progress.r16_range.y) ||
+			pf->get_32() != p_progress.parameters) {
+		return 0;
+	}
+	int rows = static_cast<int>(pf->get_32());
+	return pf->get_error() == OK ? CLAMP(rows, 0, p_progress.height) : 0;
+}
+
+Error SteerablePerlinNoise::_write_export_progress(const String &p_path, const ExportProgress &p_progress, int p_rows) {
+	Error err;
+	Ref<FileAccess> pf = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(pf.is_null(), err, "Cannot write export progress '" + p_path + "'.");
+	pf->store_32(EXPORT_PROGRESS_MAGIC);
+	pf->store_32(p_progress.width);
+	pf->store_32(p_progress.height);
+	pf->store_32(p_progress.format);
+	pf->store_32(p_progress.in_3d_space);
+	pf->store_float(p_progress.r16_range.x);
+	pf->store_float(p_progress.r16_range.y);
+	pf->store_32(p_progress.parameters);
+	pf->store_32(p_rows);
+	pf->flush();
+	err = pf->get_error();
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot write export progress '" + p_path + "'.");
+	return OK;
+}
+
+Error SteerablePerlinNoise::export_raw(const String &p_path, int p_width, int p_height, ExportFormat p_format, bool p_in_3d_space, int p_band_height, bool p_resume, Vector2 p_r16_range) const {
+	ERR_FAIL_COND_V_MSG(p_width <= 0 || p_height <= 0, ERR_INVALID_PARAMETER, "Export size must be strictly positive.");
+	ERR_FAIL_COND_V_MSG(p_band_height <= 0, ERR_INVALID_PARAMETER, "Band height must be strictly positive.");
+	ERR_FAIL_COND_V_MSG(p_format == EXPORT_FORMAT_R16 && !(p_r16_range.y > p_r16_range.x), ERR_INVALID_PARAMETER, "R16 range must be increasing.");
+
+	String progress_path = p_path + EXPORT_PROGRESS_SUFFIX;
+	ExportProgress progress;
+	progress.width = p_width;
+	progress.height = p_height;
+	progress.format = p_format;
+	progress.in_3d_space = p_in_3d_space;
+	progress.r16_range = p_r16_range;
+	progress.parameters = _parameters_hash();
+
+	int bytes_per_sample = p_format == EXPORT_FORMAT_R16 ? 2 : 4;
+	uint64_t row_bytes = static_cast<uint64_t>(p_width) * bytes_per_sample;
+
+	int start_row = 0;
+	if (p_resume && FileAccess::exists(p_path) && FileAccess::exists(progress_path)) {
+		start_row = _read_export_progress(progress_path, progress);
+		// The sidecar may outlive a truncated or replaced file, the rows it claims must be there.
+		Ref<FileAccess> existing = start_row > 0 ? FileAccess::open(p_path, FileAccess::READ) : Ref<FileAccess>();
+		if (existing.is_null() || existing->get_length() < start_row * row_bytes) {
+			start_row = 0;
+		}
+	}
+
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_path, start_row > 0 ? FileAccess::READ_WRITE : FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot open export file '" + p_path + "'.");
+	f->seek(start_row * row_bytes);
+
+	// Memory stays bounded by a single band, whatever the output size.
+	int band_height = MIN(p_band_height, p_height);
+	LocalVector<real_t> values;
+	values.resize(p_width * band_height);
+	Vector<uint8_t> buffer;
+	buffer.resize(row_bytes * band_height);
+
+	ExportBand band;
+	band.values = values.ptr();
+	band.width = p_width;
+	band.in_3d_space = p_in_3d_space;
+
+	real_t r16_scale = 65535. / (p_r16_range.y - p_r16_range.x);
+	int64_t clipped = 0;
+
+	for (int row = start_row; row < p_height; row += band_height) {
+		int rows = MIN(band_height, p_height - row);
+		band.first_row = row;
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &SteerablePerlinNoise::_export_row, &band, rows, -1, true, "SteerablePerlinNoise export");
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+		uint8_t *w = buffer.ptrw();
+		int count = rows * p_width;
+		if (p_format == EXPORT_FORMAT_R16) {
+			for (int i = 0; i < count; ++i) {
+				real_t v = (values[i] - p_r16_range.x) * r16_scale;
+				clipped += v < 0 || v > 65535;
+				w += encode_uint16(static_cast<uint16_t>(CLAMP(v, 0, 65535)), w);
+			}
+		} else {
+			for (int i = 0; i < count; ++i) {
+				w += encode_float(values[i], w);
+			}
+		}
+		f->store_buffer(buffer.ptr(), count * bytes_per_sample);
+		f->flush();
+		// A band that did not reach the disk must not be recorded as done.
+		// Short writes do not always raise the error flag, so the position is checked too.
+		err = f->get_error();
+		if (err == OK && f->get_position() != (row + rows) * row_bytes) {
+			err = ERR_FILE_CANT_WRITE;
+		}
+		ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot write export file '" + p_path + "'.");
+
+		// Progress is recorded only once the band is flushed.
+		err = _write_export_progress(progress_path, progress, row + rows);
+		if (err != OK) {
+			return err;
+		}
+	}
+
+	if (clipped > 0) {
+		WARN_PRINT(vformat("%d samples of '%s' were clipped to the R16 range [%f, %f].", clipped, p_path, p_r16_range.x, p_r16_range.y));
+	}
+
+	f.unref();
+	DirAccess::remove_absolute(progress_path);
+	return OK;
+}
@@ -0,0 +1,242 @@
+/*
+MIT License
+
+Copyright (c) 2025 Casual Garage Coder
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "core/error/error_macros.h"
+#include "core/templates/local_vector.h"
+#include "core/typedefs.h"
+#include "steerable_perlin_noise.h"
+
+// Number of progress notifications sent over a whole image.
+#define PROGRESS_STEPS 64
+
+// Samples evaluated between two cancellation checks.
+#define ASYNC_CHUNK 64
+
+// Coarse stages of a progressive image, the first one being at 1/8 resolution.
+#define PROGRESSIVE_LEVELS 3
+
+void SteerablePerlinNoise::_value_range(const real_t *values, int count, real_t &r_min, real_t &r_max) {
+	r_min = FLT_MAX;
+	r_max = -FLT_MAX;
+	for (int i = 0; i < count; ++i) {
+		r_min = MIN(r_min, values[i]);
+		r_max = MAX(r_max, values[i]);
+	}
+}
+
+PackedFloat32Array SteerablePerlinNoise::_pack_values(const LocalVector<real_t> &values) {
+	PackedFloat32Array result;
+	result.resize(values.size());
+	float *w = result.ptrw();
+	for (uint32_t i = 0; i < values.size(); ++i) {
+		w[i] = values[i];
+	}
+	return result;
+}
+
+Ref<Image> SteerablePerlinNoise::_values_to_image(const real_t *values, int width, int height, bool invert, bool normalize) {
+	int count = width * height;
+	real_t min_val = 0.;
+	real_t max_val = 0.;
+	if (normalize) {
+		_value_range(values, count, min_val, max_val);
+	}
+
+	Vector<uint8_t> data;
+	data.resize(count);
+	uint8_t *wd8 = data.ptrw();
+	for (int i = 0; i < count; ++i) {
+		wd8[i] = _to_l8(values[i], min_val, max_val, invert, normalize);
+	}
+	return Image::create_from_data(width, height, false, Image::FORMAT_L8, data);
+}
+
+int64_t SteerablePerlinNoise::generate_image_async(int p_width, int p_height, bool p_invert, bool p_in_3d_space, bool p_normalize) {
+	ERR_FAIL_COND_V_MSG(p_width <= 0 || p_height <= 0, 0, "Image size must be strictly positive.");
+
+	AsyncImageRequest request;
+	request.width = p_width;
+	request.height = p_height;
+	request.invert = p_invert;
+	request.in_3d_space = p_in_3d_space;
+	request.normalize = p_normalize;
+	return _start_async(request);
+}
+
+int64_t SteerablePerlinNoise::generate_image_progressive(int p_width, int p_height, bool p_invert, bool p_in_3d_space, bool p_normalize) {
+	ERR_FAIL_COND_V_MSG(p_width <= 0 || p_height <= 0, 0, "Image size must be strictly positive.");
+
+	AsyncImageRequest request;
+	request.width = p_width;
+	request.height = p_height;
+	request.invert = p_invert;
+	request.in_3d_space = p_in_3d_space;
+	request.normalize = p_normalize;
+	request.levels = PROGRESSIVE_LEVELS;
+	return _start_async(request);
+}
+
+int64_t SteerablePerlinNoise::_start_async(AsyncImageRequest p_request) {
+	// A new request supersedes the previous one. It is not waited for here: it stops
+	// at its next chunk and gets retired by its own _async_image_done.
+	_cancel_async();
+
+	p_request.id = ++async_last_id;
+	p_request.params = _snapshot();
+	async_last_ratio = 0.;
+	async_current.store(p_request.id);
+	async_tasks.insert(p_request.id, WorkerThreadPool::get_singleton()->add_template_task(this, &SteerablePerlinNoise::_async_image_task, p_request, false, "SteerablePerlinNoise image"));
+	return p_request.id;
+}
+
+void SteerablePerlinNoise::cancel_image_async(int64_t p_handle) {
+	// Stale handles must not cancel a more recent request.
+	async_current.compare_exchange_strong(p_handle, 0);
+}
+
+bool SteerablePerlinNoise::is_image_async_running(int64_t p_handle) const {
+	return p_handle != 0 && async_current.load() == p_handle && async_tasks.has(p_handle);
+}
+
+void SteerablePerlinNoise::_cancel_async() {
+	async_current.store(0);
+}
+
+void SteerablePerlinNoise::_async_image_task(AsyncImageRequest p_request) {
+	// Each finer stage halves the divisor and evaluates one more octave, the octaves
+	// left out of a coarse stage being above what its grid can represent anyway.
+	// Even positions of a stage are the positions of the previous one: their partial
+	// sum is kept and only the missing octaves are added.
+	int64_t total = 0;
+	for (int level = p_request.levels; level >= 0; --level) {
+		int div = 1 << level;
+		total += static_cast<int64_t>((p_request.width + div - 1) / div) * ((p_request.height + div - 1) / div);
+	}
+	std::atomic<int64_t> done(0);
+
+	LocalVector<real_t> previous;
+	int previous_width = 0;
+	int previous_octaves = 0;
+
+	for (int level = p_request.levels; level >= 0; --level) {
+		int div = 1 << level;
+		int width = (p_request.width + div - 1) / div;
+		int height = (p_request.height + div - 1) / div;
+
+		LocalVector<real_t> values;
+		values.resize(width * height);
+
+		AsyncStage stage;
+		stage.id = p_request.id;
+		stage.params = p_request.params.ptr();
+		stage.width = width;
+		stage.div = div;
+		stage.in_3d_space = p_request.in_3d_space;
+		int octaves = p_request.params->octaves;
+		stage.octaves = MAX(octaves - level, MIN(octaves, 1));
+		stage.previous = level < p_request.levels ? previous.ptr() : nullptr;
+		stage.previous_width = previous_width;
+		stage.previous_octaves = previous_octaves;
+		stage.values = values.ptr();
+		stage.done = &done;
+		stage.total = total;
+		stage.step = MAX(total / PROGRESS_STEPS, 1);
+
+		// Rows are high priority: this task holds a low priority slot while it waits for them,
+		// and with those slots capped, low priority rows could wait behind it forever.
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &SteerablePerlinNoise::_async_row, &stage, height, -1, true, "SteerablePerlinNoise image rows");
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+		if (async_current.load() != p_request.id) {
+			// Still report back so the task gets retired on the main thread.
+			callable_mp(this, &SteerablePerlinNoise::_async_image_done).call_deferred(p_request.id, Ref<Image>());
+			return;
+		}
+
+		Ref<Image> image = _values_to_image(values.ptr(), width, height, p_request.invert, p_request.normalize);
+		if (p_request.levels > 0) {
+			callable_mp(this, &SteerablePerlinNoise::_async_image_stage).call_deferred(p_request.id, image, div);
+		}
+		if (level == 0) {
+			callable_mp(this, &SteerablePerlinNoise::_async_image_done).call_deferred(p_request.id, image);
+		}
+
+		previous = std::move(values);
+		previous_width = width;
+		previous_octaves = stage.octaves;
+	}
+}
+
+void SteerablePerlinNoise::_async_row(uint32_t p_y, AsyncStage *p_stage) {
+	real_t *row = p_stage->values + p_y * p_stage->width;
+	bool reuse_row = p_stage->previous != nullptr && (p_y & 1) == 0;
+	int y = p_y * p_stage->div;
+
+	for (int begin = 0; begin < p_stage->width; begin += ASYNC_CHUNK) {
+		// Polled per chunk rather than per row, so superseded work stops quickly even on wide images.
+		if (async_current.load() != p_stage->id) {
+			return;
+		}
+		int end = MIN(begin + ASYNC_CHUNK, p_stage->width);
+		for (int x = begin; x < end; ++x) {
+			if (reuse_row && (x & 1) == 0) {
+				row[x] = p_stage->params->_sample_octaves(x * p_stage->div, y, 0, p_stage->in_3d_space, p_stage->previous_octaves, p_stage->octaves, p_stage->previous[(p_y >> 1) * p_stage->previous_width + (x >> 1)]);
+			} else {
+				row[x] = p_stage->params->_sample_octaves(x * p_stage->div, y, 0, p_stage->in_3d_space, 0, p_stage->octaves, 0.);
+			}
+		}
+
+		int64_t count = end - begin;
+		int64_t done = p_stage->done->fetch_add(count) + count;
+		if ((done - count) / p_stage->step != done / p_stage->step) {
+			callable_mp(this, &SteerablePerlinNoise::_async_image_progress).call_deferred(p_stage->id, static_cast<real_t>(done) / p_stage->total);
+		}
+	}
+}
+
+void SteerablePerlinNoise::_async_image_progress(int64_t p_id, real_t p_ratio) {
+	// Rows finish out of order, only report forward progress.
+	if (async_current.load() == p_id && p_ratio > async_last_ratio) {
+		async_last_ratio = p_ratio;
+		emit_signal(SNAME("progress"), p_ratio);
+	}
+}
+
+void SteerablePerlinNoise::_async_image_stage(int64_t p_id, const Ref<Image> &p_image, int p_divisor) {
+	if (async_current.load() == p_id) {
+		emit_signal(SNAME("stage_completed"), p_image, p_divisor);
+	}
+}
+
+void SteerablePerlinNoise::_async_image_done(int64_t p_id, const Ref<Image> &p_image) {
+	// This is the last thing the task does, so waiting here is immediate.
+	WorkerThreadPool::TaskID *task = async_tasks.getptr(p_id);
+	if (task) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(*task);
+		async_tasks.erase(p_id);
+	}
+	if (p_image.is_valid() && async_current.compare_exchange_strong(p_id, 0)) {
+		emit_signal(SNAME("completed"), p_image);
+	}
+}
@@ -0,0 +1,179 @@
+/*
+MIT License
+
+Copyright (c) 2025 Casual Garage Coder
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "core/error/error_macros.h"
+#include "core/templates/local_vector.h"
+#include "core/typedefs.h"
+#include "steerable_perlin_noise.h"
+
+// Number of selected samples handed to a worker at once.
+#define SPARSE_BATCH 256
+
+void SteerablePerlinNoise::_sparse_batch(uint32_t p_index, SparseBatch *p_batch) const {
+	int begin = p_index * SPARSE_BATCH;
+	int end = MIN(begin + SPARSE_BATCH, p_batch->count);
+	int plane = p_batch->size.x * p_batch->size.y;
+	for (int i = begin; i < end; ++i) {
+		int32_t idx = p_batch->indices[i];
+		int z = idx / plane;
+		int y = (idx - z * plane) / p_batch->size.x;
+		int x = idx - z * plane - y * p_batch->size.x;
+		p_batch->values[i] = _sample_octaves(x, y, z, p_batch->in_3d_space, 0, octaves, 0.);
+	}
+}
+
+void SteerablePerlinNoise::_evaluate_sparse(const LocalVector<int32_t> &p_indices, Vector3i p_size, bool p_in_3d_space, LocalVector<real_t> &r_values) const {
+	// Selected samples are already compacted, so work scales with coverage only.
+	r_values.resize(p_indices.size());
+	if (p_indices.is_empty()) {
+		return;
+	}
+	SparseBatch batch;
+	batch.indices = p_indices.ptr();
+	batch.values = r_values.ptr();
+	batch.count = p_indices.size();
+	batch.size = p_size;
+	batch.in_3d_space = p_in_3d_space;
+
+	int batches = (batch.count + SPARSE_BATCH - 1) / SPARSE_BATCH;
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &SteerablePerlinNoise::_sparse_batch, &batch, batches, -1, true, "SteerablePerlinNoise sparse");
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+}
+
+bool SteerablePerlinNoise::_compact_mask(const Ref<Image> &p_mask, int p_width, int p_height, real_t p_threshold, int32_t p_base, LocalVector<int32_t> &r_indices) {
+	ERR_FAIL_COND_V_MSG(p_mask.is_null(), false, "Invalid mask.");
+	ERR_FAIL_COND_V_MSG(p_mask->get_width() != p_width || p_mask->get_height() != p_height, false, "Mask size does not match the requested size.");
+	ERR_FAIL_COND_V_MSG(p_mask->is_compressed(), false, "Compressed masks are not supported.");
+
+	// Selection is read from the red channel, so L8 and R8 masks work as is.
+	for (int y = 0; y < p_height; ++y) {
+		for (int x = 0; x < p_width; ++x) {
+			if (p_mask->get_pixel(x, y).r >= p_threshold) {
+				r_indices.push_back(p_base + y * p_width + x);
+			}
+		}
+	}
+	return true;
+}
+
+PackedFloat32Array SteerablePerlinNoise::get_noise_sparse(const PackedInt32Array &p_indices, Vector3i p_size, bool p_in_3d_space) const {
+	ERR_FAIL_COND_V_MSG(p_size.x <= 0 || p_size.y <= 0 || p_size.z <= 0, PackedFloat32Array(), "Size must be strictly positive.");
+	ERR_FAIL_COND_V_MSG(static_cast<int64_t>(p_size.x) * p_size.y * p_size.z > INT32_MAX, PackedFloat32Array(), "Size is too large for linear indices.");
+
+	int32_t limit = p_size.x * p_size.y * p_size.z;
+	LocalVector<int32_t> indices;
+	indices.resize(p_indices.size());
+	for (int i = 0; i < p_indices.size(); ++i) {
+		ERR_FAIL_INDEX_V(p_indices[i], limit, PackedFloat32Array());
+		indices[i] = p_indices[i];
+	}
+
+	LocalVector<real_t> values;
+	_evaluate_sparse(indices, p_size, p_in_3d_space, values);
+	return _pack_values(values);
+}
+
+PackedFloat32Array SteerablePerlinNoise::get_noise_bitmask(const PackedByteArray &p_bits, Vector3i p_size, bool p_in_3d_space) const {
+	ERR_FAIL_COND_V_MSG(p_size.x <= 0 || p_size.y <= 0 || p_size.z <= 0, PackedFloat32Array(), "Size must be strictly positive.");
+	ERR_FAIL_COND_V_MSG(static_cast<int64_t>(p_size.x) * p_size.y * p_size.z > INT32_MAX, PackedFloat32Array(), "Size is too large for linear indices.");
+
+	int32_t limit = p_size.x * p_size.y * p_size.z;
+	ERR_FAIL_COND_V_MSG(p_bits.size() * 8 < limit, PackedFloat32Array(), "Bitmask is smaller than the requested size.");
+
+	// Bit i of the mask (LSB first) selects linear index i, results follow the same order.
+	LocalVector<int32_t> indices;
+	const uint8_t *r = p_bits.ptr();
+	for (int32_t i = 0; i < limit; ++i) {
+		if (r[i >> 3] & (1 << (i & 7))) {
+			indices.push_back(i);
+		}
+	}
+
+	LocalVector<real_t> values;
+	_evaluate_sparse(indices, p_size, p_in_3d_space, values);
+	return _pack_values(values);
+}
+
+Ref<Image> SteerablePerlinNoise::get_image_masked(int p_width, int p_height, const Ref<Image> &p_mask, real_t p_threshold, bool p_invert, bool p_in_3d_space, bool p_normalize) const {
+	ERR_FAIL_COND_V_MSG(p_width <= 0 || p_height <= 0, Ref<Image>(), "Image size must be strictly positive.");
+
+	LocalVector<int32_t> indices;
+	if (!_compact_mask(p_mask, p_width, p_height, p_threshold, 0, indices)) {
+		return Ref<Image>();
+	}
+	LocalVector<real_t> values;
+	_evaluate_sparse(indices, Vector3i(p_width, p_height, 1), p_in_3d_space, values);
+
+	// Normalization only accounts for the selected samples, the others stay at 0.
+	real_t min_val;
+	real_t max_val;
+	_value_range(values.ptr(), values.size(), min_val, max_val);
+
+	Vector<uint8_t> data;
+	data.resize(p_width * p_height);
+	uint8_t *wd8 = data.ptrw();
+	memset(wd8, 0, data.size());
+	for (uint32_t i = 0; i < indices.size(); ++i) {
+		wd8[indices[i]] = _to_l8(values[i], min_val, max_val, p_invert, p_normalize);
+	}
+	return Image::create_from_data(p_width, p_height, false, Image::FORMAT_L8, data);
+}
+
+TypedArray<Image> SteerablePerlinNoise::get_image_3d_masked(int p_width, int p_height, int p_depth, const TypedArray<Image> &p_masks, real_t p_threshold, bool p_invert, bool p_normalize) const {
+	ERR_FAIL_COND_V_MSG(p_width <= 0 || p_height <= 0 || p_depth <= 0, TypedArray<Image>(), "Image size must be strictly positive.");
+	ERR_FAIL_COND_V_MSG(static_cast<int64_t>(p_width) * p_height * p_depth > INT32_MAX, TypedArray<Image>(), "Size is too large for linear indices.");
+	ERR_FAIL_COND_V_MSG(p_masks.size() != p_depth, TypedArray<Image>(), "One mask is expected per depth slice.");
+
+	int plane = p_width * p_height;
+	LocalVector<int32_t> indices;
+	for (int d = 0; d < p_depth; ++d) {
+		if (!_compact_mask(p_masks[d], p_width, p_height, p_threshold, d * plane, indices)) {
+			return TypedArray<Image>();
+		}
+	}
+	LocalVector<real_t> values;
+	_evaluate_sparse(indices, Vector3i(p_width, p_height, p_depth), true, values);
+
+	// As for Noise::get_image_3d, normalization spans the whole volume.
+	real_t min_val;
+	real_t max_val;
+	_value_range(values.ptr(), values.size(), min_val, max_val);
+
+	// Indices are sorted by slice, so a single cursor scatters them all.
+	TypedArray<Image> images;
+	images.resize(p_depth);
+	uint32_t cursor = 0;
+	for (int d = 0; d < p_depth; ++d) {
+		Vector<uint8_t> data;
+		data.resize(plane);
+		uint8_t *wd8 = data.ptrw();
+		memset(wd8, 0, plane);
+		int32_t end = (d + 1) * plane;
+		for (; cursor < indices.size() && indices[cursor] < end; ++cursor) {
+			wd8[indices[cursor] - d * plane] = _to_l8(values[cursor], min_val, max_val, p_invert, p_normalize);
+		}
+		images[d] = Image::create_from_data(p_width, p_height, false, Image::FORMAT_L8, data);
+	}
+	return images;
+}
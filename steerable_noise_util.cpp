@@ -300,12 +300,23 @@ real_t SteerablePerlinNoise::fbm(glm::vec3 p, glm::mat3 metric) const {
 }
 
 real_t SteerablePerlinNoise::fbm_artifact_free(glm::vec3 p, glm::mat3 metric) const {
-	real_t out_val = 0.0;
+	return fbm_artifact_free(p, metric, 0, octaves, 0.0);
+}
+
+real_t SteerablePerlinNoise::fbm_artifact_free(glm::vec3 p, glm::mat3 metric, int first, int last, real_t acc) const {
+	//octaves are accumulated in order, so resuming a partial sum with the next octaves
+	//gives exactly the value of a single full evaluation.
+	real_t out_val = acc;
 	glm::vec3 shift_offset = offset + glm::vec3(seed);
 
-	for (int i = 0; i < octaves; i++) {
+	glm::vec3 base = (p + shift_offset) * frequency;
+	glm::vec3 half_base = (p + shift_offset + glm::vec3(.5)) * frequency;
+	real_t octave_scale = glm::pow(2.0f, static_cast<real_t>(first));
+
+	for (int i = first; i < last; i++) {
 		//since the weights are always heighest at the .5 position, combine two noises at the same octave to remove artifacts.
-		out_val += glm::pow(octave_bias, static_cast<real_t>(i)) * (steerable_perlin(glm::pow(2.0f, static_cast<real_t>(i)) * (p + shift_offset) * frequency, metric) + steerable_perlin(glm::pow(2.0f, static_cast<real_t>(i)) * ((p + shift_offset + glm::vec3(.5)) * frequency), metric)) * .5;
+		out_val += glm::pow(octave_bias, static_cast<real_t>(i)) * (steerable_perlin(octave_scale * base, metric) + steerable_perlin(octave_scale * half_base, metric)) * .5;
+		octave_scale *= 2.0;
 	}
 
 	return out_val;
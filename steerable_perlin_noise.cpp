@@ -24,6 +24,15 @@ SOFTWARE.
 #include "steerable_perlin_noise.h"
 #include "core/error/error_macros.h"
 
+// Non-zero while an image is built on this thread: bulk sampling must neither
+// quantize positions nor evict the hot entries of the point cache.
+static thread_local int bulk_sampling = 0;
+
+struct BulkSampling {
+	BulkSampling() { ++bulk_sampling; }
+	~BulkSampling() { --bulk_sampling; }
+};
+
 SteerablePerlinNoise::SteerablePerlinNoise() :
 		seed(0),
 		frequency(1., 1., 1.),
@@ -34,7 +43,42 @@ SteerablePerlinNoise::SteerablePerlinNoise() :
 		octave_bias(.67),
 		octaves(6),
 		noise_order(0),
-		eigen_value_sum(4.) {}
+		eigen_value_sum(4.),
+		cache_enabled(false),
+		cache_quantization(.001),
+		async_current(0),
+		async_last_id(0),
+		async_last_ratio(0.) {
+	cache.set_capacity(4096);
+}
+
+SteerablePerlinNoise::~SteerablePerlinNoise() {
+	_cancel_async();
+	for (const KeyValue<int64_t, WorkerThreadPool::TaskID> &E : async_tasks) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(E.value);
+	}
+}
+
+Ref<SteerablePerlinNoise> SteerablePerlinNoise::_snapshot() const {
+	// Members are copied directly: no setter, no signal, no cache on the copy.
+	// The map is duplicated as well, so neither its lifetime nor its parameters depend on the original.
+	Ref<SteerablePerlinNoise> copy;
+	copy.instantiate();
+	copy->seed = seed;
+	copy->frequency = frequency;
+	copy->offset = offset;
+	copy->scale = scale;
+	copy->anisotropy_strength = anisotropy_strength;
+	copy->anisotropy_vector_scale = anisotropy_vector_scale;
+	if (anisotropy_map.is_valid()) {
+		copy->anisotropy_map = anisotropy_map->duplicate(true);
+	}
+	copy->octave_bias = octave_bias;
+	copy->octaves = octaves;
+	copy->noise_order = noise_order;
+	copy->eigen_value_sum = eigen_value_sum;
+	return copy;
+}
 
 int SteerablePerlinNoise::get_seed() const {
 	return seed;
@@ -42,7 +86,7 @@ int SteerablePerlinNoise::get_seed() const {
 
 void SteerablePerlinNoise::set_seed(int s) {
 	seed = s % 16777216;
-	emit_changed();
+	_changed();
 }
 
 Vector3 SteerablePerlinNoise::get_frequency() const {
@@ -50,7 +94,7 @@ Vector3 SteerablePerlinNoise::get_frequency() const {
 }
 void SteerablePerlinNoise::set_frequency(Vector3 f) {
 	frequency = glm::vec3(f.x, f.y, f.z);
-	emit_changed();
+	_changed();
 }
 
 Vector3 SteerablePerlinNoise::get_offset() const {
@@ -58,7 +102,7 @@ Vector3 SteerablePerlinNoise::get_offset() const {
 }
 void SteerablePerlinNoise::set_offset(Vector3 f) {
 	offset = glm::vec3(f.x, f.y, f.z);
-	emit_changed();
+	_changed();
 }
 
 Vector3 SteerablePerlinNoise::get_scale() const {
@@ -66,7 +110,7 @@ Vector3 SteerablePerlinNoise::get_scale() const {
 }
 void SteerablePerlinNoise::set_scale(Vector3 f) {
 	scale = glm::vec3(f.x, f.y, f.z);
-	emit_changed();
+	_changed();
 }
 
 real_t SteerablePerlinNoise::get_octave_bias() const {
@@ -74,7 +118,7 @@ real_t SteerablePerlinNoise::get_octave_bias() const {
 }
 void SteerablePerlinNoise::set_octave_bias(real_t b) {
 	octave_bias = b;
-	emit_changed();
+	_changed();
 }
 
 real_t SteerablePerlinNoise::get_anisotropy_strength() const {
@@ -82,7 +126,7 @@ real_t SteerablePerlinNoise::get_anisotropy_strength() const {
 }
 void SteerablePerlinNoise::set_anisotropy_strength(real_t a) {
 	anisotropy_strength = a;
-	emit_changed();
+	_changed();
 }
 
 Vector2 SteerablePerlinNoise::get_anisotropy_vector_scale() const {
@@ -90,7 +134,7 @@ Vector2 SteerablePerlinNoise::get_anisotropy_vector_scale() const {
 }
 void SteerablePerlinNoise::set_anisotropy_vector_scale(Vector2 v) {
 	anisotropy_vector_scale = glm::vec2(v.x, v.y);
-	emit_changed();
+	_changed();
 }
 
 Ref<Noise> SteerablePerlinNoise::get_anisotropy_map() const {
@@ -104,7 +148,7 @@ void SteerablePerlinNoise::set_anisotropy_map(Ref<Noise> t) {
 	if (anisotropy_map.is_valid()) {
 		anisotropy_map->connect_changed(callable_mp(this, &SteerablePerlinNoise::_changed));
 	}
-	emit_changed();
+	_changed();
 }
 
 int SteerablePerlinNoise::get_octaves() const {
@@ -115,7 +159,7 @@ void SteerablePerlinNoise::set_octaves(int c) {
 		WARN_PRINT("Invalid octave number. Set to 0.");
 	}
 	octaves = MAX(c, 0);
-	emit_changed();
+	_changed();
 }
 
 int SteerablePerlinNoise::get_noise_order() const {
@@ -127,7 +171,7 @@ void SteerablePerlinNoise::set_noise_order(int o) {
 		WARN_PRINT("Noise order must be positive. Set to 0.");
 	}
 	noise_order = MAX(o, 0);
-	emit_changed();
+	_changed();
 }
 
 real_t SteerablePerlinNoise::get_eigen_value_sum() const {
@@ -135,7 +179,70 @@ real_t SteerablePerlinNoise::get_eigen_value_sum() const {
 }
 void SteerablePerlinNoise::set_eigen_value_sum(real_t s) {
 	eigen_value_sum = s;
-	emit_changed();
+	_changed();
+}
+
+bool SteerablePerlinNoise::is_cache_enabled() const {
+	return cache_enabled;
+}
+void SteerablePerlinNoise::set_cache_enabled(bool e) {
+	cache_enabled = e;
+	if (!cache_enabled) {
+		cache.release();
+	}
+	_changed();
+}
+
+int SteerablePerlinNoise::get_cache_size() const {
+	return cache.get_capacity();
+}
+void SteerablePerlinNoise::set_cache_size(int s) {
+	if (s < 0) {
+		WARN_PRINT("Cache size must be positive. Set to 0.");
+	}
+	cache.set_capacity(MAX(s, 0));
+}
+
+real_t SteerablePerlinNoise::get_cache_quantization() const {
+	return cache_quantization;
+}
+void SteerablePerlinNoise::set_cache_quantization(real_t q) {
+	if (q <= 0.) {
+		WARN_PRINT("Cache quantization must be strictly positive. Set to 0.001.");
+		q = .001;
+	}
+	cache_quantization = q;
+	_changed();
+}
+
+uint64_t SteerablePerlinNoise::get_cache_hits() const {
+	return cache.get_hits();
+}
+
+uint64_t SteerablePerlinNoise::get_cache_misses() const {
+	return cache.get_misses();
+}
+
+void SteerablePerlinNoise::reset_cache_statistics() {
+	cache.reset_statistics();
+}
+
+void SteerablePerlinNoise::clear_cache() {
+	cache.clear();
+}
+
+bool SteerablePerlinNoise::_quantize(const Vector3 &p_v, Vector3i &r_key) const {
+	// Non-finite positions have no key, and would not convert to integers anyway.
+	if (!p_v.is_finite()) {
+		return false;
+	}
+	Vector3 q = (p_v / cache_quantization).round();
+	// Positions too far away for the key range are simply not cached.
+	if (Math::abs(q.x) >= INT32_MAX || Math::abs(q.y) >= INT32_MAX || Math::abs(q.z) >= INT32_MAX) {
+		return false;
+	}
+	r_key = Vector3i(q.x, q.y, q.z);
+	return true;
 }
 
 real_t SteerablePerlinNoise::get_noise_1d(real_t p_x) const {
@@ -143,6 +250,21 @@ real_t SteerablePerlinNoise::get_noise_1d(real_t p_x) const {
 }
 
 real_t SteerablePerlinNoise::get_noise_2dv(Vector2 p_v) const {
+	Vector3i key;
+	if (!cache_enabled || bulk_sampling > 0 || !_quantize(Vector3(p_v.x, p_v.y, 0.), key)) {
+		return _noise_2d(p_v, 0, octaves, 0.);
+	}
+	// Sample at the quantized position so the cached value does not depend on which query filled it.
+	uint32_t version = cache.get_version();
+	real_t value;
+	if (!cache.lookup(key, 2, version, value)) {
+		value = _noise_2d(Vector2(key.x, key.y) * cache_quantization, 0, octaves, 0.);
+		cache.store(key, 2, version, value);
+	}
+	return value;
+}
+
+real_t SteerablePerlinNoise::_noise_2d(Vector2 p_v, int p_first, int p_last, real_t p_acc) const {
 	glm::vec2 pv(p_v.x, p_v.y);
 	glm::vec2 p = pv;
 	glm::vec2 s2(scale.x, scale.y);
@@ -159,9 +281,9 @@ real_t SteerablePerlinNoise::get_noise_2dv(Vector2 p_v) const {
 
 	glm::mat2 metric = generate_metric(aniso_dir * anisotropy_vector_scale);
 	metric = anisotropy_strength * metric + glm::mat2(1.) * (1.f - anisotropy_strength);
-	real_t out_val = 0.;
+	real_t out_val = p_acc;
 	glm::vec2 f2(frequency.x, frequency.y);
-	for (int i = 0; i < octaves; ++i) {
+	for (int i = p_first; i < p_last; ++i) {
 		out_val += pow(octave_bias, static_cast<real_t>(i)) * aniso_perlin(glm::pow(2.0f, static_cast<real_t>(i)) * p * f2, metric);
 	}
 	return out_val;
@@ -172,15 +294,49 @@ real_t SteerablePerlinNoise::get_noise_2d(real_t p_x, real_t p_y) const {
 }
 
 real_t SteerablePerlinNoise::get_noise_3dv(Vector3 p_v) const {
+	Vector3i key;
+	if (!cache_enabled || bulk_sampling > 0 || !_quantize(p_v, key)) {
+		return _noise_3d(p_v, 0, octaves, 0.);
+	}
+	uint32_t version = cache.get_version();
+	real_t value;
+	if (!cache.lookup(key, 3, version, value)) {
+		value = _noise_3d(Vector3(key) * cache_quantization, 0, octaves, 0.);
+		cache.store(key, 3, version, value);
+	}
+	return value;
+}
+
+real_t SteerablePerlinNoise::_noise_3d(Vector3 p_v, int p_first, int p_last, real_t p_acc) const {
 	glm::vec3 anisotropy_dir(p_v.z, 0., -p_v.x);
 	glm::mat3 x = generate_metric(anisotropy_dir);
-	return fbm_artifact_free(glm::vec3(p_v.x, p_v.y, p_v.z), x);
+	return fbm_artifact_free(glm::vec3(p_v.x, p_v.y, p_v.z), x, p_first, p_last, p_acc);
 }
 
 real_t SteerablePerlinNoise::get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const {
 	return get_noise_3dv(Vector3(p_x, p_y, p_z));
 }
 
+Ref<Image> SteerablePerlinNoise::get_image(int p_width, int p_height, bool p_invert, bool p_in_3d_space, bool p_normalize) const {
+	BulkSampling bulk;
+	return Noise::get_image(p_width, p_height, p_invert, p_in_3d_space, p_normalize);
+}
+
+TypedArray<Image> SteerablePerlinNoise::get_image_3d(int p_width, int p_height, int p_depth, bool p_invert, bool p_normalize) const {
+	BulkSampling bulk;
+	return Noise::get_image_3d(p_width, p_height, p_depth, p_invert, p_normalize);
+}
+
+Ref<Image> SteerablePerlinNoise::get_seamless_image(int p_width, int p_height, bool p_invert, bool p_in_3d_space, real_t p_blend_skirt, bool p_normalize) const {
+	BulkSampling bulk;
+	return Noise::get_seamless_image(p_width, p_height, p_invert, p_in_3d_space, p_blend_skirt, p_normalize);
+}
+
+TypedArray<Image> SteerablePerlinNoise::get_seamless_image_3d(int p_width, int p_height, int p_depth, bool p_invert, real_t p_blend_skirt, bool p_normalize) const {
+	BulkSampling bulk;
+	return Noise::get_seamless_image_3d(p_width, p_height, p_depth, p_invert, p_blend_skirt, p_normalize);
+}
+
 void SteerablePerlinNoise::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_seed"), &SteerablePerlinNoise::get_seed);
 	ClassDB::bind_method(D_METHOD("set_seed", "s"), &SteerablePerlinNoise::set_seed);
@@ -215,6 +371,36 @@ void SteerablePerlinNoise::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_eigen_value_sum"), &SteerablePerlinNoise::get_eigen_value_sum);
 	ClassDB::bind_method(D_METHOD("set_eigen_value_sum"), &SteerablePerlinNoise::set_eigen_value_sum);
 
+	ClassDB::bind_method(D_METHOD("is_cache_enabled"), &SteerablePerlinNoise::is_cache_enabled);
+	ClassDB::bind_method(D_METHOD("set_cache_enabled", "e"), &SteerablePerlinNoise::set_cache_enabled);
+
+	ClassDB::bind_method(D_METHOD("get_cache_size"), &SteerablePerlinNoise::get_cache_size);
+	ClassDB::bind_method(D_METHOD("set_cache_size", "s"), &SteerablePerlinNoise::set_cache_size);
+
+	ClassDB::bind_method(D_METHOD("get_cache_quantization"), &SteerablePerlinNoise::get_cache_quantization);
+	ClassDB::bind_method(D_METHOD("set_cache_quantization", "q"), &SteerablePerlinNoise::set_cache_quantization);
+
+	ClassDB::bind_method(D_METHOD("get_cache_hits"), &SteerablePerlinNoise::get_cache_hits);
+	ClassDB::bind_method(D_METHOD("get_cache_misses"), &SteerablePerlinNoise::get_cache_misses);
+	ClassDB::bind_method(D_METHOD("reset_cache_statistics"), &SteerablePerlinNoise::reset_cache_statistics);
+	ClassDB::bind_method(D_METHOD("clear_cache"), &SteerablePerlinNoise::clear_cache);
+
+	ClassDB::bind_method(D_METHOD("generate_image_async", "width", "height", "invert", "in_3d_space", "normalize"), &SteerablePerlinNoise::generate_image_async, DEFVAL(false), DEFVAL(false), DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("generate_image_progressive", "width", "height", "invert", "in_3d_space", "normalize"), &SteerablePerlinNoise::generate_image_progressive, DEFVAL(false), DEFVAL(false), DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("cancel_image_async", "handle"), &SteerablePerlinNoise::cancel_image_async);
+	ClassDB::bind_method(D_METHOD("is_image_async_running", "handle"), &SteerablePerlinNoise::is_image_async_running);
+
+	ClassDB::bind_method(D_METHOD("get_noise_sparse", "indices", "size", "in_3d_space"), &SteerablePerlinNoise::get_noise_sparse, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("get_noise_bitmask", "bits", "size", "in_3d_space"), &SteerablePerlinNoise::get_noise_bitmask, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("get_image_masked", "width", "height", "mask", "threshold", "invert", "in_3d_space", "normalize"), &SteerablePerlinNoise::get_image_masked, DEFVAL(.5), DEFVAL(false), DEFVAL(false), DEFVAL(true));
+	ClassDB::bind_method(D_METHOD("get_image_3d_masked", "width", "height", "depth", "masks", "threshold", "invert", "normalize"), &SteerablePerlinNoise::get_image_3d_masked, DEFVAL(.5), DEFVAL(false), DEFVAL(true));
+
+	ClassDB::bind_method(D_METHOD("export_raw", "path", "width", "height", "format", "in_3d_space", "band_height", "resume", "r16_range"), &SteerablePerlinNoise::export_raw, DEFVAL(EXPORT_FORMAT_RF32), DEFVAL(false), DEFVAL(256), DEFVAL(true), DEFVAL(Vector2(-1, 1)));
+
+	ADD_SIGNAL(MethodInfo("progress", PropertyInfo(Variant::FLOAT, "ratio")));
+	ADD_SIGNAL(MethodInfo("stage_completed", PropertyInfo(Variant::OBJECT, "image", PROPERTY_HINT_RESOURCE_TYPE, "Image"), PropertyInfo(Variant::INT, "divisor")));
+	ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::OBJECT, "image", PROPERTY_HINT_RESOURCE_TYPE, "Image")));
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
 	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "frequency", PROPERTY_HINT_RANGE, "0.,16,0.001,or_less,or_greater"), "set_frequency", "get_frequency");
 	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "offset", PROPERTY_HINT_RANGE, "-1000,1000,0.01,or_less,or_greater"), "set_offset", "get_offset");
@@ -232,4 +418,12 @@ void SteerablePerlinNoise::_bind_methods() {
 	ADD_GROUP("Fractal", "fractal_");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "fractal_octave_bias"), "set_octave_bias", "get_octave_bias");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "fractal_octaves"), "set_octaves", "get_octaves");
+
+	BIND_ENUM_CONSTANT(EXPORT_FORMAT_R16);
+	BIND_ENUM_CONSTANT(EXPORT_FORMAT_RF32);
+
+	ADD_GROUP("Cache", "cache_");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "cache_enabled"), "set_cache_enabled", "is_cache_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_size", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater"), "set_cache_size", "get_cache_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cache_quantization", PROPERTY_HINT_RANGE, "0.0001,1,0.0001,or_greater"), "set_cache_quantization", "get_cache_quantization");
 }
\ No newline at end of file
@@ -23,20 +23,42 @@ SOFTWARE.
 */
 #pragma once
 
+#include "core/io/image.h"
 #include "core/object/object.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/typedefs.h"
+#include "core/variant/typed_array.h"
 #include "modules/noise/noise.h"
+#include "steerable_noise_cache.h"
 
+#include <atomic>
 #include <glm/glm.hpp>
 
+#ifdef TESTS_ENABLED
+namespace TestSteerablePerlinNoise {
+struct Access;
+}
+#endif
+
 class SteerablePerlinNoise : public Noise {
 	GDCLASS(SteerablePerlinNoise, Noise);
 	OBJ_SAVE_TYPE(SteerablePerlinNoise);
 
+#ifdef TESTS_ENABLED
+	friend struct TestSteerablePerlinNoise::Access;
+#endif
+
 public:
+	enum ExportFormat {
+		EXPORT_FORMAT_R16,
+		EXPORT_FORMAT_RF32,
+	};
+
 	SteerablePerlinNoise();
 
-	virtual ~SteerablePerlinNoise() {}
+	virtual ~SteerablePerlinNoise();
 
 	_FORCE_INLINE_ int get_seed() const;
 	_FORCE_INLINE_ void set_seed(int s);
@@ -71,6 +93,20 @@ public:
 	_FORCE_INLINE_ real_t get_eigen_value_sum() const;
 	_FORCE_INLINE_ void set_eigen_value_sum(real_t s);
 
+	_FORCE_INLINE_ bool is_cache_enabled() const;
+	_FORCE_INLINE_ void set_cache_enabled(bool e);
+
+	_FORCE_INLINE_ int get_cache_size() const;
+	void set_cache_size(int s);
+
+	_FORCE_INLINE_ real_t get_cache_quantization() const;
+	void set_cache_quantization(real_t q);
+
+	uint64_t get_cache_hits() const;
+	uint64_t get_cache_misses() const;
+	void reset_cache_statistics();
+	void clear_cache();
+
 	real_t get_noise_1d(real_t p_x) const override;
 
 	real_t get_noise_2dv(Vector2 p_v) const override;
@@ -79,11 +115,147 @@ public:
 	real_t get_noise_3dv(Vector3 p_v) const override;
 	real_t get_noise_3d(real_t p_x, real_t p_y, real_t p_z) const override;
 
+	Ref<Image> get_image(int p_width, int p_height, bool p_invert = false, bool p_in_3d_space = false, bool p_normalize = true) const override;
+	TypedArray<Image> get_image_3d(int p_width, int p_height, int p_depth, bool p_invert = false, bool p_normalize = true) const override;
+	Ref<Image> get_seamless_image(int p_width, int p_height, bool p_invert = false, bool p_in_3d_space = false, real_t p_blend_skirt = 0.1, bool p_normalize = true) const override;
+	TypedArray<Image> get_seamless_image_3d(int p_width, int p_height, int p_depth, bool p_invert = false, real_t p_blend_skirt = 0.1, bool p_normalize = true) const override;
+
+	int64_t generate_image_async(int p_width, int p_height, bool p_invert = false, bool p_in_3d_space = false, bool p_normalize = true);
+	int64_t generate_image_progressive(int p_width, int p_height, bool p_invert = false, bool p_in_3d_space = false, bool p_normalize = true);
+	void cancel_image_async(int64_t p_handle);
+	bool is_image_async_running(int64_t p_handle) const;
+
+	PackedFloat32Array get_noise_sparse(const PackedInt32Array &p_indices, Vector3i p_size, bool p_in_3d_space = false) const;
+	PackedFloat32Array get_noise_bitmask(const PackedByteArray &p_bits, Vector3i p_size, bool p_in_3d_space = false) const;
+	Ref<Image> get_image_masked(int p_width, int p_height, const Ref<Image> &p_mask, real_t p_threshold = .5, bool p_invert = false, bool p_in_3d_space = false, bool p_normalize = true) const;
+	TypedArray<Image> get_image_3d_masked(int p_width, int p_height, int p_depth, const TypedArray<Image> &p_masks, real_t p_threshold = .5, bool p_invert = false, bool p_normalize = true) const;
+
+	// RF32 stores the raw field. R16 maps p_r16_range linearly onto [0, 65535] and clips
+	// outside of it: the field is not bounded by [-1, 1], its extent grows with the octave weights.
+	Error export_raw(const String &p_path, int p_width, int p_height, ExportFormat p_format = EXPORT_FORMAT_RF32, bool p_in_3d_space = false, int p_band_height = 256, bool p_resume = true, Vector2 p_r16_range = Vector2(-1, 1)) const;
+
 protected:
 	static void _bind_methods();
 
 private:
-	_FORCE_INLINE_ void _changed() { emit_changed(); }
+	_FORCE_INLINE_ void _changed() {
+		cache.invalidate();
+		// Anything still being generated was built from the old parameters.
+		_cancel_async();
+		emit_changed();
+	}
+
+	bool _quantize(const Vector3 &, Vector3i &) const;
+
+	real_t _noise_2d(Vector2, int, int, real_t) const;
+
+	real_t _noise_3d(Vector3, int, int, real_t) const;
+
+	struct AsyncImageRequest {
+		int64_t id = 0;
+		int width = 0;
+		int height = 0;
+		bool invert = false;
+		bool in_3d_space = false;
+		bool normalize = true;
+		// Number of coarse stages rendered before the full resolution one.
+		int levels = 0;
+		// Parameters frozen when the request started, so setters never race with the workers.
+		Ref<SteerablePerlinNoise> params;
+	};
+
+	Ref<SteerablePerlinNoise> _snapshot() const;
+
+	_FORCE_INLINE_ real_t _sample_octaves(int p_x, int p_y, int p_z, bool p_in_3d_space, int p_first, int p_last, real_t p_acc) const {
+		return p_in_3d_space ? _noise_3d(Vector3(p_x, p_y, p_z), p_first, p_last, p_acc) : _noise_2d(Vector2(p_x, p_y), p_first, p_last, p_acc);
+	}
+
+	_FORCE_INLINE_ static uint8_t _to_l8(real_t p_value, real_t p_min, real_t p_max, bool p_invert, bool p_normalize) {
+		// Same mapping as Noise::get_image, without normalization the expected range is [-1, 1].
+		uint8_t ivalue;
+		if (!p_normalize) {
+			ivalue = static_cast<uint8_t>(CLAMP(p_value * 127.5f + 127.5f, 0, 255));
+		} else if (p_max == p_min) {
+			ivalue = 0;
+		} else {
+			ivalue = static_cast<uint8_t>(CLAMP((p_value - p_min) / (p_max - p_min) * 255.f, 0, 255));
+		}
+		return p_invert ? 255 - ivalue : ivalue;
+	}
+
+	static void _value_range(const real_t *, int, real_t &, real_t &);
+
+	static PackedFloat32Array _pack_values(const LocalVector<real_t> &);
+
+	static Ref<Image> _values_to_image(const real_t *, int, int, bool, bool);
+
+	void _cancel_async();
+
+	int64_t _start_async(AsyncImageRequest);
+
+	// One stage of an asynchronous image, shared by the rows evaluated in parallel.
+	struct AsyncStage {
+		int64_t id = 0;
+		const SteerablePerlinNoise *params = nullptr;
+		int width = 0;
+		int div = 1;
+		bool in_3d_space = false;
+		int octaves = 0;
+		const real_t *previous = nullptr;
+		int previous_width = 0;
+		int previous_octaves = 0;
+		real_t *values = nullptr;
+		std::atomic<int64_t> *done = nullptr;
+		int64_t total = 0;
+		int64_t step = 1;
+	};
+
+	void _async_image_task(AsyncImageRequest);
+
+	void _async_row(uint32_t, AsyncStage *);
+
+	void _async_image_progress(int64_t, real_t);
+
+	void _async_image_stage(int64_t, const Ref<Image> &, int);
+
+	void _async_image_done(int64_t, const Ref<Image> &);
+
+	struct ExportBand {
+		real_t *values = nullptr;
+		int width = 0;
+		int first_row = 0;
+		bool in_3d_space = false;
+	};
+
+	void _export_row(uint32_t, ExportBand *) const;
+
+	uint32_t _parameters_hash() const;
+
+	struct ExportProgress {
+		int width = 0;
+		int height = 0;
+		ExportFormat format = EXPORT_FORMAT_RF32;
+		bool in_3d_space = false;
+		Vector2 r16_range;
+		uint32_t parameters = 0;
+	};
+
+	static int _read_export_progress(const String &, const ExportProgress &);
+	static Error _write_export_progress(const String &, const ExportProgress &, int);
+
+	struct SparseBatch {
+		const int32_t *indices = nullptr;
+		real_t *values = nullptr;
+		int count = 0;
+		Vector3i size;
+		bool in_3d_space = false;
+	};
+
+	void _sparse_batch(uint32_t, SparseBatch *) const;
+
+	void _evaluate_sparse(const LocalVector<int32_t> &, Vector3i, bool, LocalVector<real_t> &) const;
+
+	static bool _compact_mask(const Ref<Image> &, int, int, real_t, int32_t, LocalVector<int32_t> &);
 
 	_FORCE_INLINE_ static real_t random3(glm::vec3);
 
@@ -131,6 +303,8 @@ private:
 
 	real_t fbm_artifact_free(glm::vec3, glm::mat3) const;
 
+	real_t fbm_artifact_free(glm::vec3, glm::mat3, int, int, real_t) const;
+
 	real_t fbm_projected(glm::vec3, glm::mat2, glm::mat3) const;
 
 	real_t aniso_perlin(glm::vec2, glm::mat2) const;
@@ -157,4 +331,22 @@ private:
 	int noise_order;
 
 	real_t eigen_value_sum;
-};
\ No newline at end of file
+
+	bool cache_enabled;
+
+	real_t cache_quantization;
+
+	mutable SteerableNoiseCache cache;
+
+	// Id of the asynchronous request allowed to run, 0 when none.
+	std::atomic<int64_t> async_current;
+
+	int64_t async_last_id;
+
+	real_t async_last_ratio;
+
+	// Tasks not retired yet, superseded ones included. Only touched on the main thread.
+	HashMap<int64_t, WorkerThreadPool::TaskID> async_tasks;
+};
+
+VARIANT_ENUM_CAST(SteerablePerlinNoise::ExportFormat);
@@ -0,0 +1,577 @@
+/*
+MIT License
+
+Copyright (c) 2025 Casual Garage Coder
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+
+#include "../steerable_perlin_noise.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/math/random_pcg.h"
+#include "core/object/message_queue.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+#include "tests/test_utils.h"
+
+namespace TestSteerablePerlinNoise {
+
+// Every optimized path is checked against the scalar implementation it replaces.
+constexpr double EXACT_TOLERANCE = 1e-5;
+constexpr real_t CACHE_QUANTIZATION = 1e-4;
+// The cache answers with the value at the nearest grid position, at most half a cell diagonal away.
+constexpr double CACHE_STEP = CACHE_QUANTIZATION * .8660254037844386;
+// Bound on the slope of one steerable_perlin call per unit of metric eigenvalue sum: the corner
+// terms are linear in the metric and their weights are bounded, this keeps a margin over both.
+constexpr double KERNEL_SLOPE = 8.;
+// Bound on how fast the 3D metric turns per unit of position, valid while |x| and |z| stay above 1:
+// the anisotropy direction is (z, 0, -x) and generate_metric flips sign across those planes.
+constexpr double METRIC_SLOPE = 8.;
+constexpr int PARAMETER_SETS = 8;
+constexpr int SAMPLES = 512;
+
+struct Access {
+	static void randomize(SteerablePerlinNoise *p_noise, RandomPCG &p_rng) {
+		// Seeds and offsets shift the sampled positions, small ones keep their fractional precision.
+		p_noise->seed = p_rng.random(0, 64);
+		p_noise->frequency = glm::vec3(p_rng.random(.01f, 4.f), p_rng.random(.01f, 4.f), p_rng.random(.01f, 4.f));
+		p_noise->offset = glm::vec3(p_rng.random(-16.f, 16.f), p_rng.random(-16.f, 16.f), p_rng.random(-16.f, 16.f));
+		p_noise->scale = glm::vec3(p_rng.random(.1f, 100.f), p_rng.random(.1f, 100.f), p_rng.random(.1f, 100.f));
+		p_noise->anisotropy_strength = p_rng.random(0.f, 1.f);
+		p_noise->anisotropy_vector_scale = glm::vec2(p_rng.random(-4.f, 4.f), p_rng.random(-4.f, 4.f));
+		p_noise->octave_bias = p_rng.random(.1f, .9f);
+		p_noise->octaves = p_rng.random(1, 8);
+		p_noise->noise_order = p_rng.random(0, 2);
+		p_noise->eigen_value_sum = p_rng.random(1.f, 8.f);
+	}
+
+	static glm::mat3 random_metric(const SteerablePerlinNoise *p_noise, RandomPCG &p_rng) {
+		glm::vec3 dir(p_rng.random(-1.f, 1.f), p_rng.random(-1.f, 1.f), p_rng.random(-1.f, 1.f));
+		return p_noise->generate_metric(glm::length(dir) > 1e-3f ? dir : glm::vec3(1., 0., 0.));
+	}
+
+	static int octaves(const SteerablePerlinNoise *p_noise) {
+		return p_noise->octaves;
+	}
+
+	static real_t fbm_artifact_free(const SteerablePerlinNoise *p_noise, glm::vec3 p_pos, glm::mat3 p_metric) {
+		return p_noise->fbm_artifact_free(p_pos, p_metric);
+	}
+
+	// Original loop, recomputing the scaled positions at every octave, kept as the golden reference.
+	static real_t fbm_artifact_free_reference(const SteerablePerlinNoise *p_noise, glm::vec3 p, glm::mat3 metric) {
+		real_t out_val = 0.0;
+		glm::vec3 shift_offset = p_noise->offset + glm::vec3(p_noise->seed);
+		for (int i = 0; i < p_noise->octaves; i++) {
+			out_val += glm::pow(p_noise->octave_bias, static_cast<real_t>(i)) * (p_noise->steerable_perlin(glm::pow(2.0f, static_cast<real_t>(i)) * (p + shift_offset) * p_noise->frequency, metric) + p_noise->steerable_perlin(glm::pow(2.0f, static_cast<real_t>(i)) * ((p + shift_offset + glm::vec3(.5)) * p_noise->frequency), metric)) * .5;
+		}
+		return out_val;
+	}
+
+	// Largest drift between a cached query and the exact field, from the field's slope over CACHE_STEP.
+	// Octave i samples at 2^i * frequency with weight bias^i, its metric is shared by every octave.
+	static double cache_tolerance(const SteerablePerlinNoise *p_noise) {
+		double frequency = MAX(MAX(Math::abs(p_noise->frequency.x), Math::abs(p_noise->frequency.y)), Math::abs(p_noise->frequency.z));
+		double weights = 0.;
+		double scaled_weights = 0.;
+		for (int i = 0; i < p_noise->octaves; ++i) {
+			weights += Math::pow(static_cast<double>(p_noise->octave_bias), i);
+			scaled_weights += Math::pow(2. * p_noise->octave_bias, i);
+		}
+		return CACHE_STEP * KERNEL_SLOPE * p_noise->eigen_value_sum * (frequency * scaled_weights + METRIC_SLOPE * weights) + EXACT_TOLERANCE;
+	}
+
+	// Position a cached query is actually evaluated at.
+	static Vector3 quantized(const SteerablePerlinNoise *p_noise, const Vector3 &p_pos) {
+		Vector3i key;
+		return p_noise->_quantize(p_pos, key) ? Vector3(key) * p_noise->cache_quantization : p_pos;
+	}
+
+	static real_t noise_2d(const SteerablePerlinNoise *p_noise, Vector2 p_pos, int p_first, int p_last, real_t p_acc) {
+		return p_noise->_noise_2d(p_pos, p_first, p_last, p_acc);
+	}
+
+	static real_t noise_3d(const SteerablePerlinNoise *p_noise, Vector3 p_pos, int p_first, int p_last, real_t p_acc) {
+		return p_noise->_noise_3d(p_pos, p_first, p_last, p_acc);
+	}
+
+	// Writes the sidecar of an interrupted 2D RF32 export, optionally for other parameters.
+	static void write_export_progress(const SteerablePerlinNoise *p_noise, const String &p_path, int p_width, int p_height, int p_rows, uint32_t p_parameters_xor = 0) {
+		SteerablePerlinNoise::ExportProgress progress;
+		progress.width = p_width;
+		progress.height = p_height;
+		progress.format = SteerablePerlinNoise::EXPORT_FORMAT_RF32;
+		progress.r16_range = Vector2(-1, 1);
+		progress.parameters = p_noise->_parameters_hash() ^ p_parameters_xor;
+		REQUIRE(SteerablePerlinNoise::_write_export_progress(p_path + ".progress", progress, p_rows) == OK);
+	}
+};
+
+struct AccuracyStats {
+	double max_error = 0.;
+	double sum_error = 0.;
+	uint64_t count = 0;
+	uint64_t reference_usec = 0;
+	uint64_t fast_usec = 0;
+};
+
+// Runs the reference over every input, then the fast path as a whole, timing both.
+template <typename R, typename F>
+void measure(int p_count, R p_reference, F p_fast, AccuracyStats &r_stats) {
+	LocalVector<real_t> reference;
+	LocalVector<real_t> fast;
+	reference.resize(p_count);
+	fast.resize(p_count);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; ++i) {
+		reference[i] = p_reference(i);
+	}
+	uint64_t middle = OS::get_singleton()->get_ticks_usec();
+	p_fast(fast);
+	uint64_t end = OS::get_singleton()->get_ticks_usec();
+
+	r_stats.reference_usec += middle - begin;
+	r_stats.fast_usec += end - middle;
+	for (int i = 0; i < p_count; ++i) {
+		double error = Math::abs(static_cast<double>(reference[i]) - fast[i]);
+		r_stats.max_error = MAX(r_stats.max_error, error);
+		r_stats.sum_error += error;
+	}
+	r_stats.count += p_count;
+}
+
+void check(const String &p_name, const AccuracyStats &p_stats, double p_bound) {
+	double count = MAX(p_stats.count, uint64_t(1));
+	MESSAGE(vformat("%s: max error %.3e, mean error %.3e, reference %.1f ns/sample, fast %.1f ns/sample.",
+			p_name, p_stats.max_error, p_stats.sum_error / count, p_stats.reference_usec * 1000. / count, p_stats.fast_usec * 1000. / count));
+	CHECK_MESSAGE(p_stats.max_error <= p_bound, vformat("%s drifts from its reference.", p_name));
+}
+
+Ref<Image> completed_image;
+
+void on_completed(const Ref<Image> &p_image) {
+	completed_image = p_image;
+}
+
+Ref<Image> wait_for_image() {
+	for (int i = 0; i < 60000 && completed_image.is_null(); ++i) {
+		MessageQueue::get_singleton()->flush();
+		OS::get_singleton()->delay_usec(1000);
+	}
+	Ref<Image> image = completed_image;
+	completed_image.unref();
+	return image;
+}
+
+TEST_CASE("[SteerablePerlinNoise] Artifact-free fbm matches the scalar reference") {
+	RandomPCG rng(26);
+	AccuracyStats artifact_free;
+
+	for (int set = 0; set < PARAMETER_SETS; ++set) {
+		Ref<SteerablePerlinNoise> noise;
+		noise.instantiate();
+		Access::randomize(noise.ptr(), rng);
+
+		LocalVector<glm::vec3> points;
+		LocalVector<glm::mat3> metrics;
+		for (int i = 0; i < SAMPLES; ++i) {
+			points.push_back(glm::vec3(rng.random(-1000.f, 1000.f), rng.random(-1000.f, 1000.f), rng.random(-1000.f, 1000.f)));
+			metrics.push_back(Access::random_metric(noise.ptr(), rng));
+		}
+
+		measure(
+				SAMPLES,
+				[&](int i) { return Access::fbm_artifact_free_reference(noise.ptr(), points[i], metrics[i]); },
+				[&](LocalVector<real_t> &r_out) {
+					for (int i = 0; i < SAMPLES; ++i) {
+						r_out[i] = Access::fbm_artifact_free(noise.ptr(), points[i], metrics[i]);
+					}
+				},
+				artifact_free);
+	}
+
+	check("fbm_artifact_free", artifact_free, EXACT_TOLERANCE);
+}
+
+TEST_CASE("[SteerablePerlinNoise] Resumed octave sums match a full evaluation") {
+	RandomPCG rng(29);
+	AccuracyStats resume_2d;
+	AccuracyStats resume_3d;
+
+	for (int set = 0; set < PARAMETER_SETS; ++set) {
+		Ref<SteerablePerlinNoise> noise;
+		noise.instantiate();
+		Access::randomize(noise.ptr(), rng);
+		const SteerablePerlinNoise *n = noise.ptr();
+		int octaves = Access::octaves(n);
+		int split = rng.random(0, octaves);
+
+		LocalVector<Vector3> points;
+		for (int i = 0; i < SAMPLES; ++i) {
+			points.push_back(Vector3(rng.random(-1000.f, 1000.f), rng.random(-1000.f, 1000.f), rng.random(-1000.f, 1000.f)));
+		}
+
+		measure(
+				SAMPLES,
+				[&](int i) { return Access::noise_2d(n, Vector2(points[i].x, points[i].y), 0, octaves, 0.); },
+				[&](LocalVector<real_t> &r_out) {
+					for (int i = 0; i < SAMPLES; ++i) {
+						Vector2 p(points[i].x, points[i].y);
+						r_out[i] = Access::noise_2d(n, p, split, octaves, Access::noise_2d(n, p, 0, split, 0.));
+					}
+				},
+				resume_2d);
+
+		measure(
+				SAMPLES,
+				[&](int i) { return Access::noise_3d(n, points[i], 0, octaves, 0.); },
+				[&](LocalVector<real_t> &r_out) {
+					for (int i = 0; i < SAMPLES; ++i) {
+						r_out[i] = Access::noise_3d(n, points[i], split, octaves, Access::noise_3d(n, points[i], 0, split, 0.));
+					}
+				},
+				resume_3d);
+	}
+
+	check("octave resume 2D", resume_2d, EXACT_TOLERANCE);
+	check("octave resume 3D", resume_3d, EXACT_TOLERANCE);
+}
+
+TEST_CASE("[SteerablePerlinNoise] Cached queries stay close to the exact field") {
+	RandomPCG rng(27);
+
+	for (int set = 0; set < PARAMETER_SETS; ++set) {
+		Ref<SteerablePerlinNoise> noise;
+		noise.instantiate();
+		Access::randomize(noise.ptr(), rng);
+		noise->set_cache_quantization(CACHE_QUANTIZATION);
+		noise->set_cache_size(SAMPLES * 4);
+		const SteerablePerlinNoise *n = noise.ptr();
+
+		// Away from the x = 0 and z = 0 planes, see METRIC_SLOPE.
+		LocalVector<Vector3> points;
+		for (int i = 0; i < SAMPLES; ++i) {
+			real_t x = rng.random(1.f, 100.f) * (rng.rand() & 1 ? 1 : -1);
+			real_t z = rng.random(1.f, 100.f) * (rng.rand() & 1 ? 1 : -1);
+			points.push_back(Vector3(x, rng.random(-100.f, 100.f), z));
+		}
+
+		// Warm the cache first so the timed pass measures hits.
+		noise->set_cache_enabled(true);
+		for (const Vector3 &p : points) {
+			noise->get_noise_3dv(p);
+		}
+		AccuracyStats cached;
+		measure(
+				SAMPLES,
+				[&](int i) { return Access::noise_3d(n, points[i], 0, Access::octaves(n), 0.); },
+				[&](LocalVector<real_t> &r_out) {
+					for (int i = 0; i < SAMPLES; ++i) {
+						r_out[i] = n->get_noise_3dv(points[i]);
+					}
+				},
+				cached);
+		CHECK(noise->get_cache_hits() > 0);
+		check(vformat("cached get_noise_3d, set %d", set), cached, Access::cache_tolerance(n));
+
+		// Hits must return exactly the field at the quantized position, nothing staler.
+		int mismatches = 0;
+		for (const Vector3 &p : points) {
+			mismatches += n->get_noise_3dv(p) != Access::noise_3d(n, Access::quantized(n, p), 0, Access::octaves(n), 0.);
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+TEST_CASE("[SteerablePerlinNoise] Setters invalidate cached queries") {
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	noise->set_cache_enabled(true);
+	const SteerablePerlinNoise *n = noise.ptr();
+	Vector3 p(12.34, -5.67, 8.9);
+
+	real_t before = noise->get_noise_3dv(p);
+	CHECK(noise->get_noise_3dv(p) == before);
+	uint64_t hits = noise->get_cache_hits();
+	uint64_t misses = noise->get_cache_misses();
+	CHECK(hits == 1);
+
+	noise->set_seed(noise->get_seed() + 17);
+	real_t after = noise->get_noise_3dv(p);
+	CHECK(noise->get_cache_hits() == hits);
+	CHECK(noise->get_cache_misses() == misses + 1);
+	CHECK(after == Access::noise_3d(n, Access::quantized(n, p), 0, Access::octaves(n), 0.));
+	CHECK(after != before);
+}
+
+TEST_CASE("[SteerablePerlinNoise] Anisotropy map changes invalidate cached queries") {
+	Ref<SteerablePerlinNoise> map;
+	map.instantiate();
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	noise->set_anisotropy_map(map);
+	noise->set_cache_enabled(true);
+	const SteerablePerlinNoise *n = noise.ptr();
+	Vector2 p(3.21, -6.54);
+
+	real_t before = noise->get_noise_2dv(p);
+	CHECK(noise->get_noise_2dv(p) == before);
+	uint64_t hits = noise->get_cache_hits();
+	uint64_t misses = noise->get_cache_misses();
+
+	// Only the map changes: its changed signal must be enough to drop the cached value.
+	map->set_seed(map->get_seed() + 5);
+	real_t after = noise->get_noise_2dv(p);
+	CHECK(noise->get_cache_hits() == hits);
+	CHECK(noise->get_cache_misses() == misses + 1);
+	Vector3 q = Access::quantized(n, Vector3(p.x, p.y, 0.));
+	CHECK(after == Access::noise_2d(n, Vector2(q.x, q.y), 0, Access::octaves(n), 0.));
+}
+
+TEST_CASE("[SteerablePerlinNoise] Sparse evaluation matches scalar sampling") {
+	RandomPCG rng(31);
+	AccuracyStats sparse;
+	Vector3i size(64, 64, 16);
+
+	for (int set = 0; set < PARAMETER_SETS; ++set) {
+		Ref<SteerablePerlinNoise> noise;
+		noise.instantiate();
+		Access::randomize(noise.ptr(), rng);
+		const SteerablePerlinNoise *n = noise.ptr();
+
+		PackedInt32Array indices;
+		indices.resize(SAMPLES);
+		for (int i = 0; i < SAMPLES; ++i) {
+			indices.write[i] = rng.random(0, size.x * size.y * size.z - 1);
+		}
+
+		measure(
+				SAMPLES,
+				[&](int i) {
+					int32_t idx = indices[i];
+					Vector3 p(idx % size.x, (idx / size.x) % size.y, idx / (size.x * size.y));
+					return Access::noise_3d(n, p, 0, Access::octaves(n), 0.);
+				},
+				[&](LocalVector<real_t> &r_out) {
+					PackedFloat32Array values = n->get_noise_sparse(indices, size, true);
+					for (int i = 0; i < SAMPLES; ++i) {
+						r_out[i] = values[i];
+					}
+				},
+				sparse);
+	}
+
+	check("get_noise_sparse", sparse, EXACT_TOLERANCE);
+}
+
+TEST_CASE("[SteerablePerlinNoise] Banded export matches scalar sampling") {
+	RandomPCG rng(30);
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	Access::randomize(noise.ptr(), rng);
+	const SteerablePerlinNoise *n = noise.ptr();
+
+	// Odd sizes and a band height that does not divide them exercise the last partial band.
+	const int width = 37;
+	const int height = 23;
+	String path = TestUtils::get_temp_path("steerable_perlin_export.r32");
+	REQUIRE(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_RF32, false, 7, false) == OK);
+	CHECK_FALSE(FileAccess::exists(path + ".progress"));
+
+	Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+	REQUIRE(f.is_valid());
+	CHECK(f->get_length() == uint64_t(width * height * 4));
+
+	AccuracyStats exported;
+	measure(
+			width * height,
+			[&](int i) { return static_cast<real_t>(static_cast<float>(Access::noise_2d(n, Vector2(i % width, i / width), 0, Access::octaves(n), 0.))); },
+			[&](LocalVector<real_t> &r_out) {
+				for (int i = 0; i < width * height; ++i) {
+					r_out[i] = f->get_float();
+				}
+			},
+			exported);
+	f.unref();
+	DirAccess::remove_absolute(path);
+
+	check("export_raw", exported, EXACT_TOLERANCE);
+}
+
+TEST_CASE("[SteerablePerlinNoise] R16 export maps the requested range") {
+	RandomPCG rng(31);
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	Access::randomize(noise.ptr(), rng);
+	const SteerablePerlinNoise *n = noise.ptr();
+
+	const int width = 29;
+	const int height = 13;
+	const Vector2 range(-3, 3);
+	String path = TestUtils::get_temp_path("steerable_perlin_export.r16");
+	REQUIRE(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_R16, false, 5, false, range) == OK);
+
+	Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+	REQUIRE(f.is_valid());
+	REQUIRE(f->get_length() == uint64_t(width * height * 2));
+	int mismatches = 0;
+	for (int i = 0; i < width * height; ++i) {
+		real_t v = (Access::noise_2d(n, Vector2(i % width, i / width), 0, Access::octaves(n), 0.) - range.x) * (65535. / (range.y - range.x));
+		mismatches += Math::abs(int(f->get_16()) - int(CLAMP(v, 0, 65535))) > 1;
+	}
+	f.unref();
+	DirAccess::remove_absolute(path);
+	CHECK(mismatches == 0);
+
+	ERR_PRINT_OFF;
+	CHECK(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_R16, false, 5, false, Vector2(1, 1)) == ERR_INVALID_PARAMETER);
+	ERR_PRINT_ON;
+}
+
+Vector<uint8_t> read_file(const String &p_path) {
+	Vector<uint8_t> bytes = FileAccess::get_file_as_bytes(p_path);
+	DirAccess::remove_absolute(p_path);
+	return bytes;
+}
+
+// Writes an interrupted export: rows outside [p_first_row, p_last_row) are garbage.
+void write_partial_export(const String &p_path, const Vector<uint8_t> &p_fresh, int p_row_bytes, int p_first_row, int p_last_row) {
+	Vector<uint8_t> bytes = p_fresh;
+	uint8_t *w = bytes.ptrw();
+	for (int i = 0; i < bytes.size(); ++i) {
+		int row = i / p_row_bytes;
+		if (row < p_first_row || row >= p_last_row) {
+			w[i] = 0xA5;
+		}
+	}
+	Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(f.is_valid());
+	f->store_buffer(bytes.ptr(), bytes.size());
+}
+
+TEST_CASE("[SteerablePerlinNoise] Export resumes only from a matching, complete sidecar") {
+	RandomPCG rng(32);
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	Access::randomize(noise.ptr(), rng);
+	const SteerablePerlinNoise *n = noise.ptr();
+
+	const int width = 37;
+	const int height = 23;
+	const int band = 7;
+	const int row_bytes = width * 4;
+	String path = TestUtils::get_temp_path("steerable_perlin_resume.r32");
+	REQUIRE(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_RF32, false, band, false) == OK);
+	Vector<uint8_t> fresh = read_file(path);
+	REQUIRE(fresh.size() == width * height * 4);
+
+	SUBCASE("Recorded rows are kept, the others regenerated") {
+		// Row 0 is corrupted on purpose: surviving the resume proves it was not rewritten.
+		write_partial_export(path, fresh, row_bytes, 1, 2 * band);
+		Access::write_export_progress(n, path, width, height, 2 * band);
+		REQUIRE(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_RF32, false, band, true) == OK);
+		CHECK_FALSE(FileAccess::exists(path + ".progress"));
+		Vector<uint8_t> resumed = read_file(path);
+		REQUIRE(resumed.size() == fresh.size());
+		CHECK(resumed[0] == 0xA5);
+		CHECK(resumed.slice(row_bytes) == fresh.slice(row_bytes));
+	}
+
+	SUBCASE("A sidecar for other parameters restarts from row 0") {
+		write_partial_export(path, fresh, row_bytes, 1, 2 * band);
+		Access::write_export_progress(n, path, width, height, 2 * band, 1);
+		REQUIRE(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_RF32, false, band, true) == OK);
+		CHECK(read_file(path) == fresh);
+	}
+
+	SUBCASE("A sidecar claiming more rows than the file holds restarts from row 0") {
+		write_partial_export(path, fresh.slice(0, band * row_bytes), row_bytes, 1, band);
+		Access::write_export_progress(n, path, width, height, 2 * band);
+		REQUIRE(n->export_raw(path, width, height, SteerablePerlinNoise::EXPORT_FORMAT_RF32, false, band, true) == OK);
+		CHECK(read_file(path) == fresh);
+	}
+}
+
+TEST_CASE("[SteerablePerlinNoise] Asynchronous and progressive images match get_image") {
+	RandomPCG rng(28);
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	Access::randomize(noise.ptr(), rng);
+	noise->connect("completed", callable_mp_static(&on_completed));
+
+	const int width = 45;
+	const int height = 31;
+	Ref<Image> reference = noise->get_image(width, height);
+
+	noise->generate_image_async(width, height);
+	Ref<Image> async_image = wait_for_image();
+	REQUIRE(async_image.is_valid());
+	CHECK(async_image->get_data() == reference->get_data());
+
+	noise->generate_image_progressive(width, height);
+	Ref<Image> progressive_image = wait_for_image();
+	REQUIRE(progressive_image.is_valid());
+	CHECK(progressive_image->get_data() == reference->get_data());
+
+	noise->disconnect("completed", callable_mp_static(&on_completed));
+}
+
+TEST_CASE("[SteerablePerlinNoise] Superseded and cancelled images neither stall nor race with setters") {
+	RandomPCG rng(29);
+	Ref<SteerablePerlinNoise> noise;
+	noise.instantiate();
+	Access::randomize(noise.ptr(), rng);
+	noise->connect("completed", callable_mp_static(&on_completed));
+
+	const int width = 96;
+	const int height = 64;
+	for (int i = 0; i < 32; ++i) {
+		int64_t handle = noise->generate_image_progressive(width, height);
+		// Replacing the map frees the one the running request was started with.
+		Ref<SteerablePerlinNoise> map;
+		map.instantiate();
+		map->set_seed(i);
+		noise->set_anisotropy_map(map);
+		noise->set_seed(i);
+		noise->generate_image_async(width, height, false, i & 1);
+		noise->cancel_image_async(handle);
+		if (i & 1) {
+			noise->cancel_image_async(noise->generate_image_async(width, height));
+		}
+	}
+
+	Ref<Image> reference = noise->get_image(width, height);
+	noise->generate_image_async(width, height);
+	Ref<Image> image = wait_for_image();
+	REQUIRE(image.is_valid());
+	CHECK(image->get_data() == reference->get_data());
+
+	// Destroying the noise with requests in flight must wait for them rather than hang.
+	noise->generate_image_progressive(width, height);
+	noise->disconnect("completed", callable_mp_static(&on_completed));
+	noise.unref();
+	MessageQueue::get_singleton()->flush();
+	CHECK(completed_image.is_null());
+}
+
+} // namespace TestSteerablePerlinNoise